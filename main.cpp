@@ -1,3 +1,4 @@
+#include <cerrno>
 #include <cstdio>
 #include <cstdint>
 #include <cstdlib>
@@ -7,12 +8,25 @@
 #include <vector>
 #include <variant>
 #include <map>
+#include <algorithm>
 #include <stdexcept>
 #if defined(_WIN32)
 #include <Windows.h>
 #include <io.h>
 #else
+#include <atomic>
+#include <thread>
+#include <fcntl.h>
 #include <unistd.h>
+#include <zlib.h>
+#if __has_include(<zstd.h>)
+#include <zstd.h>
+#define PRIDECAT_HAVE_ZSTD 1
+#endif
+#endif
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <sys/stat.h>
 #endif
 
 struct color_t {
@@ -24,6 +38,9 @@ struct color_t {
 	{}
 	color_t(uint8_t r, uint8_t g, uint8_t b)
 	: r(r), g(g), b(b) {}
+	uint32_t rgb() const {
+		return (r << 16) | (g << 8) | b;
+	}
 };
 
 enum class StretchRuleVertical : uint8_t {
@@ -55,6 +72,11 @@ enum class colorAdjust : uint8_t {
 	darken
 };
 
+enum class outputFormat : uint8_t {
+	ansi,
+	html
+};
+
 std::map<std::string, flag_t const> allFlags = {
 	{ "lgbt", {
 		// info: https://en.wikipedia.org/wiki/Rainbow_flag_(LGBT)
@@ -357,9 +379,17 @@ std::vector<color_t> g_colorQueue;
 std::vector<std::string> g_filesToCat;
 unsigned int g_currentRow = 0;
 unsigned int g_currentColumn = 0;
+int g_previousChar = '\n';
+int g_fixedFlagWidth = -1; // -1 means stretch 2D flags to each file's longest line
 bool two_dimensiona_flag = false;
 flag_t current2dFlag;
 auto g_colorAdjustment = colorAdjust::none;
+auto g_outputFormat = outputFormat::ansi;
+
+// html output opens spans lazily, so runs of same-colored characters share one span
+constexpr int64_t noSpan = -1;
+int64_t g_pendingSpanColor = noSpan;
+int64_t g_openSpanColor = noSpan;
 
 int stretchToHeight = 0;
 
@@ -375,6 +405,14 @@ bool g_useColors = isatty(STDOUT_FILENO);
 bool g_trueColor = isTrueColorTerminal();
 #endif
 bool g_setBackgroundColor = false;
+bool g_fillLines = false;
+bool g_followLastFile = false;
+
+long g_startLine = 0;
+long g_byteRangeStart = 0;
+long g_byteRangeEnd = 0;
+bool g_byteRangeToEndOfFile = false;
+bool g_useByteRange = false;
 
 
 bool strEqual(char const* a, char const* b) {
@@ -492,8 +530,35 @@ void resetBackgroundColor() {
 	fputs("\033[49m", stdout);
 }
 
+void fillToEndOfLine() {
+	if (!g_useColors || !g_fillLines || g_outputFormat != outputFormat::ansi)
+		return;
+
+	// erase-in-line paints the rest of the line with the current background color
+	fputs("\033[K", stdout);
+}
+
+// whether the line's fill has to go right before c. for \r\n line endings that's before the \r,
+// since erasing after it would wipe out the line we just printed
+bool fillsBefore(int const c, FILE* fh) {
+	if (!g_fillLines || (c != '\n' && c != '\r'))
+		return false;
+	if (c == '\n')
+		return g_previousChar != '\r'; // already filled before the \r
+
+	int const next = getc(fh);
+	ungetc(next, fh);
+	return next == '\n';
+}
+
+void printCssClassName(color_t const& color) {
+	fprintf(stdout, "pc-%06x", adjustForReadability(color).rgb());
+}
+
 void setColor(color_t const& color) {
-	if (g_setBackgroundColor) {
+	if (g_outputFormat == outputFormat::html) {
+		g_pendingSpanColor = color.rgb();
+	} else if (g_setBackgroundColor) {
 		setBackgroundColor(color);
 	} else {
 		setTextColor(color);
@@ -501,13 +566,99 @@ void setColor(color_t const& color) {
 }
 
 void resetColor() {
-	if (g_setBackgroundColor) {
+	if (g_outputFormat == outputFormat::html) {
+		g_pendingSpanColor = noSpan;
+	} else if (g_setBackgroundColor) {
 		resetBackgroundColor();
 	} else {
 		resetTextColor();
 	}
 }
 
+void closeSpan() {
+	if (g_openSpanColor != noSpan) {
+		fputs("</span>", stdout);
+		g_openSpanColor = noSpan;
+	}
+}
+
+void writeChar(int c) {
+	if (g_outputFormat == outputFormat::ansi) {
+		putc(c, stdout);
+		return;
+	}
+
+	// newlines stay outside of spans so every line starts fresh
+	int64_t const wantedColor = (c == '\n') ? noSpan : g_pendingSpanColor;
+	if (wantedColor != g_openSpanColor) {
+		closeSpan();
+		if (wantedColor != noSpan) {
+			fputs("<span class=\"", stdout);
+			printCssClassName(color_t(static_cast<uint32_t>(wantedColor)));
+			fputs("\">", stdout);
+			g_openSpanColor = wantedColor;
+		}
+	}
+
+	switch (c) {
+		case '&': fputs("&amp;", stdout); break;
+		case '<': fputs("&lt;", stdout); break;
+		case '>': fputs("&gt;", stdout); break;
+		default: putc(c, stdout); break;
+	}
+}
+
+void writeHtmlHeader() {
+	std::vector<color_t> colors = g_colorQueue;
+	if (two_dimensiona_flag) {
+		for (auto const& row : std::get<std::vector<std::vector<color_t>>>(current2dFlag.colors)) {
+			colors.insert(colors.end(), row.begin(), row.end());
+		}
+	}
+
+	fputs("<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<style>\n", stdout);
+	std::map<uint32_t, color_t> uniqueColors;
+	for (color_t const& color : colors) {
+		uniqueColors.emplace(color.rgb(), color);
+	}
+	for (auto const&[rgb, color] : uniqueColors) {
+		putc('.', stdout);
+		printCssClassName(color);
+		fprintf(
+			stdout,
+			" { %s: #%06x; }\n",
+			g_setBackgroundColor ? "background-color" : "color",
+			adjustForReadability(color).rgb()
+		);
+	}
+	fputs("</style>\n</head>\n<body>\n<pre>", stdout);
+}
+
+void writeHtmlFooter() {
+	closeSpan();
+	fputs("</pre>\n</body>\n</html>\n", stdout);
+}
+
+void parseByteRange(char const* arg) {
+	char* end = nullptr;
+	errno = 0;
+	g_byteRangeStart = strtol(arg, &end, 10);
+	bool valid = end != arg && *end == ':' && errno == 0 && g_byteRangeStart >= 0;
+	if (valid) {
+		char const* const endArg = end + 1;
+		g_byteRangeToEndOfFile = *endArg == '\0';
+		if (!g_byteRangeToEndOfFile) {
+			g_byteRangeEnd = strtol(endArg, &end, 10);
+			valid = end != endArg && *end == '\0' && errno == 0 && g_byteRangeEnd >= g_byteRangeStart;
+		}
+	}
+	if (!valid) {
+		fprintf(stderr, "pridecat: Invalid byte range '%s'\n", arg);
+		exit(1);
+	}
+	g_useByteRange = true;
+}
+
 void parseCommandLine(const int argc, char** argv) {
 	bool finishedReadingFlags = false;
 	for (int i = 1; i < argc; ++i) {
@@ -527,6 +678,30 @@ void parseCommandLine(const int argc, char** argv) {
 				exit(1);
 			}
 		}
+		else if (strEqual(argv[i], "--start-line")) {
+			if (i + 1 < argc) {
+				try {
+					g_startLine = std::stol(argv[++i]);
+				} catch (std::logic_error&) {
+					g_startLine = -1;
+				}
+				if (g_startLine < 0) {
+					fprintf(stderr, "pridecat: Invalid line number '%s'\n", argv[i]);
+					exit(1);
+				}
+			} else {
+				fprintf(stderr, "pridecat: Expected an argument after %s\n", argv[i]);
+				exit(1);
+			}
+		}
+		else if (strEqual(argv[i], "--byte-range")) {
+			if (i + 1 < argc) {
+				parseByteRange(argv[++i]);
+			} else {
+				fprintf(stderr, "pridecat: Expected an argument after %s\n", argv[i]);
+				exit(1);
+			}
+		}
 		else if (strEqual(argv[i], "-h") || strEqual(argv[i], "--help")) {
 			printf("pridecat!\n");
 			printf("It's like cat but more colorful :)\n");
@@ -570,6 +745,8 @@ void parseCommandLine(const int argc, char** argv) {
 			printf("Additional options:\n");
 			printf("  -b,--background\n");
 			printf("      Change the background color instead of the text color\n\n");
+			printf("  --fill\n");
+			printf("      Extend the background color to the edge of the terminal (implies -b)\n\n");
 			printf("  -f,--force\n");
 			printf("      Force color even when stdout is not a tty\n\n");
 			printf("  -t,--truecolor\n");
@@ -582,6 +759,14 @@ void parseCommandLine(const int argc, char** argv) {
 			printf("      Darken colors slightly for improved readability on light backgrounds\n\n");
 			printf("  -s,--stretch <height>\n");
 			printf("      Stretch the flag to a certain height before repeating\n\n");
+			printf("  --start-line <n>\n");
+			printf("      Color the input as if it started at line n of a larger file\n\n");
+			printf("  --byte-range <start>:<end>\n");
+			printf("      Only output bytes [start, end) of the file, colored exactly as in a full run\n\n");
+			printf("  -F,--follow\n");
+			printf("      Keep reading the last file as it grows, like tail -F\n\n");
+			printf("  --format=<ansi|html>\n");
+			printf("      Output terminal escape sequences (default) or a standalone HTML document\n\n");
 			printf("  -h,--help\n");
 			printf("      Display this message\n\n");
 
@@ -603,12 +788,30 @@ void parseCommandLine(const int argc, char** argv) {
 		else if (strEqual(argv[i], "-b") || strEqual(argv[i], "--background")) {
 			g_setBackgroundColor = true;
 		}
+		else if (strEqual(argv[i], "-F") || strEqual(argv[i], "--follow")) {
+			g_followLastFile = true;
+		}
+		else if (strEqual(argv[i], "--fill")) {
+			g_setBackgroundColor = true;
+			g_fillLines = true;
+		}
 		else if (strEqual(argv[i], "-l") || strEqual(argv[i], "--lighten")) {
 			g_colorAdjustment = colorAdjust::lighten;
 		}
 		else if (strEqual(argv[i], "-d") || strEqual(argv[i], "--darken")) {
 			g_colorAdjustment = colorAdjust::darken;
 		}
+		else if (startsWith(argv[i], "--format=")) {
+			char const* const format = argv[i] + strlen("--format=");
+			if (strEqual(format, "ansi")) {
+				g_outputFormat = outputFormat::ansi;
+			} else if (strEqual(format, "html")) {
+				g_outputFormat = outputFormat::html;
+			} else {
+				fprintf(stderr, "pridecat: Unknown output format '%s'\n", format);
+				exit(1);
+			}
+		}
 		else if (strEqual(argv[i], "--")) {
 			finishedReadingFlags = true;
 		}
@@ -633,12 +836,30 @@ void parseCommandLine(const int argc, char** argv) {
 	}
 }
 
+void writeUnbuffered(char const* text) {
+#if defined(_WIN32)
+	_write(_fileno(stdout), text, static_cast<unsigned int>(strlen(text)));
+#else
+	if (write(STDOUT_FILENO, text, strlen(text)) < 0) {
+		// nothing left to do about it, we're on our way out
+	}
+#endif
+}
+
 void abortHandler(int signo) {
-	resetColor();
-	exit(signo);
+	// stdio and exit() aren't async-signal-safe: with the decompression thread around, they can
+	// deadlock on locks held by whatever we interrupted. whatever is still in stdout's buffer is dropped
+	if (g_outputFormat == outputFormat::html) {
+		writeUnbuffered("</pre>\n</body>\n</html>\n");
+	} else if (g_useColors) {
+		writeUnbuffered(g_setBackgroundColor ? "\033[49m" : "\033[39m");
+	}
+	_exit(signo);
 }
 
-void catFile2d(FILE* fh) {
+int longestLineLength(FILE* fh) {
+	// measures from the current position onwards, then rewinds back to it
+	long const start = ftell(fh);
 	int longestLine = 0;
 	char* line = nullptr;
 	size_t len = 0;
@@ -649,15 +870,28 @@ void catFile2d(FILE* fh) {
 			longestLine = static_cast<int>(read);
 		}
 	}
-	fseek(fh, 0, SEEK_SET);
+	fseek(fh, start, SEEK_SET);
 
+	if (line) {
+		free(line);
+	}
+	return longestLine;
+}
+
+void catFile2d(FILE* fh, long length, int longestLine) {
 	const int flagHeight = static_cast<int>(std::get<std::vector<std::vector<color_t>>>(current2dFlag.colors).size());
 	const auto flag = stretch2dFlagTo(current2dFlag, longestLine, flagHeight);
 	const auto& colors = std::get<std::vector<std::vector<color_t>>>(flag.colors);
 
 
 	int c;
-	while ((c = getc(fh)) >= 0) {
+	while (length-- != 0 && (c = getc(fh)) >= 0) {
+		if (fillsBefore(c, fh)) {
+			// fill the rest of the line with the rightmost column's color
+			setColor(colors[g_currentRow].back());
+			fillToEndOfLine();
+			resetColor();
+		}
 		if (c == '\n') {
 			g_currentRow++;
 			g_currentColumn = 0;
@@ -665,30 +899,35 @@ void catFile2d(FILE* fh) {
 				g_currentRow = 0;
 			}
 			resetColor();
-			putc(c, stdout);
+			writeChar(c);
 		} else {
-			setColor(colors[g_currentRow][g_currentColumn]);
-			putc(c, stdout);
+			// lines longer than the flag was stretched to keep the rightmost column's color
+			auto const& row = colors[g_currentRow];
+			setColor(row[std::min<size_t>(g_currentColumn, row.size() - 1)]);
+			writeChar(c);
 			resetColor();
 			g_currentColumn++;
 		}
-	}
-
-	if (line) {
-		free(line);
+		g_previousChar = c;
 	}
 }
 
-void catFile(FILE* fh) {
+// length is the number of bytes to output, or -1 to read until the end of the file
+void catFile(FILE* fh, long length = -1) {
 	if (two_dimensiona_flag) {
-		catFile2d(fh);
+		catFile2d(fh, length, g_fixedFlagWidth >= 0 ? g_fixedFlagWidth : longestLineLength(fh));
+		return;
 	}
 	int c;
-	while ((c = getc(fh)) >= 0) {
+	while (length-- != 0 && (c = getc(fh)) >= 0) {
+		if (fillsBefore(c, fh)) {
+			fillToEndOfLine();
+		}
 		if (c == '\n') {
 			resetColor();
 		}
-		putc(c, stdout);
+		writeChar(c);
+		g_previousChar = c;
 		if (c == '\n') {
 			g_currentRow++;
 			if (g_currentRow == g_colorQueue.size()) {
@@ -699,6 +938,295 @@ void catFile(FILE* fh) {
 	}
 }
 
+#if !defined(_WIN32)
+enum class compression : uint8_t {
+	none,
+	gzip,
+	zstd
+};
+
+compression detectCompression(int const fd) {
+	unsigned char magic[4] = {};
+	ssize_t const magicLength = pread(fd, magic, sizeof(magic), 0);
+	if (magicLength >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+		return compression::gzip;
+	}
+	if (magicLength == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+		return compression::zstd;
+	}
+	return compression::none;
+}
+
+// decompresses all of fd (taking ownership of it), passing each block to output.
+// returns false if the input is corrupt, or if output returned false to stop early
+template <typename Output>
+bool decompress(int const fd, compression const type, Output&& output) {
+	if (type == compression::gzip) {
+		gzFile const gz = gzdopen(fd, "rb");
+		if (!gz) {
+			close(fd);
+			return false;
+		}
+		gzbuffer(gz, 1 << 17);
+		char buffer[65536];
+		int bytesRead;
+		while ((bytesRead = gzread(gz, buffer, sizeof(buffer))) > 0) {
+			if (!output(buffer, bytesRead)) {
+				break;
+			}
+		}
+		// gzclose is where a gzip stream that was cut short gets reported
+		int const closeResult = gzclose(gz);
+		return bytesRead == 0 && closeResult == Z_OK;
+	}
+
+#if defined(PRIDECAT_HAVE_ZSTD)
+	FILE* const source = fdopen(fd, "rb");
+	ZSTD_DCtx* const context = ZSTD_createDCtx();
+	std::vector<char> inBuffer(ZSTD_DStreamInSize());
+	std::vector<char> outBuffer(ZSTD_DStreamOutSize());
+	// a non-zero hint at the end means the last frame was cut short
+	size_t hint = 0;
+	bool ok = source && context;
+	size_t bytesRead;
+	while (ok && (bytesRead = fread(inBuffer.data(), 1, inBuffer.size(), source)) > 0) {
+		ZSTD_inBuffer in = { inBuffer.data(), bytesRead, 0 };
+		while (ok && in.pos < in.size) {
+			ZSTD_outBuffer out = { outBuffer.data(), outBuffer.size(), 0 };
+			hint = ZSTD_decompressStream(context, &out, &in);
+			ok = !ZSTD_isError(hint) && output(outBuffer.data(), out.pos);
+		}
+	}
+	ZSTD_freeDCtx(context);
+	if (source) {
+		fclose(source);
+	}
+	return ok && hint == 0;
+#else
+	close(fd);
+	return false;
+#endif
+}
+
+// set before the pipe is closed, so it's up to date once the reader hits EOF
+std::atomic<bool> g_decompressFailed { false };
+
+// runs on its own detached thread, so exit() never has to wait for it or clean it up
+void decompressToPipe(int const fd, compression const type, int const pipeFd, std::string const& filepath) {
+	bool writeFailed = false;
+	bool const ok = decompress(fd, type, [&](char const* p, size_t length) {
+		while (length > 0) {
+			ssize_t const written = write(pipeFd, p, length);
+			if (written < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				writeFailed = true;
+				return false;
+			}
+			p += written;
+			length -= written;
+		}
+		return true;
+	});
+	if (!ok && !writeFailed) {
+		fprintf(stderr, "pridecat: Could not decompress %s.\n", filepath.c_str());
+		g_decompressFailed = true;
+	}
+	close(pipeFd);
+}
+#endif
+
+// opens a file for reading, transparently decompressing it if it's gzip or zstd compressed
+FILE* openInput(std::string const& filepath, bool const needsSeeking) {
+#if defined(_WIN32)
+	return fopen(filepath.c_str(), "rb");
+#else
+	int const fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return nullptr;
+	}
+
+	compression const type = detectCompression(fd);
+	if (type == compression::none) {
+		return fdopen(fd, "rb");
+	}
+#if !defined(PRIDECAT_HAVE_ZSTD)
+	if (type == compression::zstd) {
+		fprintf(stderr, "pridecat: %s is zstd-compressed, but pridecat was built without zstd support.\n", filepath.c_str());
+		exit(1);
+	}
+#endif
+
+	if (needsSeeking) {
+		// pipes can't seek, so decompress into a temporary file up front instead
+		FILE* const tmp = tmpfile();
+		if (!tmp) {
+			close(fd);
+			return nullptr;
+		}
+		bool writeFailed = false;
+		bool const ok = decompress(fd, type, [&](char const* p, size_t length) {
+			writeFailed = fwrite(p, 1, length, tmp) != length;
+			return !writeFailed;
+		});
+		// a full disk may only show up once the buffered writes are flushed
+		if (writeFailed || fflush(tmp) != 0) {
+			fprintf(stderr, "pridecat: Could not write the decompressed contents of %s to a temporary file.\n", filepath.c_str());
+			exit(1);
+		}
+		if (!ok) {
+			fprintf(stderr, "pridecat: Could not decompress %s.\n", filepath.c_str());
+			exit(1);
+		}
+		rewind(tmp);
+		return tmp;
+	}
+
+	int pipeFds[2];
+	if (pipe(pipeFds) != 0) {
+		close(fd);
+		return nullptr;
+	}
+	// decompression overlaps with colorizing, and finishes by closing its end of the pipe
+	std::thread(decompressToPipe, fd, type, pipeFds[1], filepath).detach();
+	return fdopen(pipeFds[0], "rb");
+#endif
+}
+
+unsigned int flagHeight() {
+	if (two_dimensiona_flag) {
+		return std::get<std::vector<std::vector<color_t>>>(current2dFlag.colors).size();
+	}
+	return g_colorQueue.size();
+}
+
+// returns whether the range reached the end of the file
+bool catByteRange(FILE* fh) {
+	// a 2D flag is as wide as the longest line in the whole file, not just in our range
+	int const longestLine = two_dimensiona_flag ? longestLineLength(fh) : 0;
+
+	// memchr is vectorized by the libc, so this is much faster than getc
+	unsigned long lines = 0;
+	unsigned long column = 0;
+	char buffer[65536];
+	for (long remaining = g_byteRangeStart; remaining > 0;) {
+		size_t const bytesRead = fread(buffer, 1, std::min<long>(remaining, sizeof(buffer)), fh);
+		if (bytesRead == 0) {
+			break;
+		}
+		char const* p = buffer;
+		char const* const end = buffer + bytesRead;
+		while (auto const* newline = static_cast<char const*>(memchr(p, '\n', end - p))) {
+			++lines;
+			column = 0;
+			p = newline + 1;
+		}
+		column += end - p;
+		remaining -= bytesRead;
+		g_previousChar = buffer[bytesRead - 1];
+	}
+	g_currentRow = lines % flagHeight();
+	g_currentColumn = column;
+	if (g_outputFormat == outputFormat::html && column > 0) {
+		// pick up inside the span the previous shard left open for byte start-1
+		if (two_dimensiona_flag) {
+			const int height = static_cast<int>(flagHeight());
+			const auto flag = stretch2dFlagTo(current2dFlag, longestLine, height);
+			const auto& row = std::get<std::vector<std::vector<color_t>>>(flag.colors)[g_currentRow];
+			g_openSpanColor = row[std::min<size_t>(column - 1, row.size() - 1)].rgb();
+		} else {
+			g_openSpanColor = g_colorQueue[g_currentRow].rgb();
+		}
+	}
+	if (g_outputFormat == outputFormat::html && !two_dimensiona_flag) {
+		// the ansi color is still active from the previous shard, but the html span color isn't
+		g_pendingSpanColor = g_colorQueue[g_currentRow].rgb();
+	}
+
+	long const length = g_byteRangeToEndOfFile ? -1 : g_byteRangeEnd - g_byteRangeStart;
+	if (two_dimensiona_flag) {
+		catFile2d(fh, length, longestLine);
+	} else {
+		catFile(fh, length);
+	}
+	return getc(fh) == EOF;
+}
+
+#if defined(__linux__)
+void followFile(FILE* fh, std::string const& filepath) {
+	// compressed streams can't be picked up again partway through an append
+	if (detectCompression(fileno(fh)) != compression::none) {
+		fprintf(stderr, "pridecat: Can't follow %s, since it's compressed.\n", filepath.c_str());
+		exit(1);
+	}
+
+	// watch the directory rather than the file itself, so we also hear about
+	// a new file being created (or moved) in place of a rotated one
+	size_t const slash = filepath.rfind('/');
+	std::string const directory = (slash == std::string::npos) ? "." : filepath.substr(0, slash + 1);
+	std::string const filename = (slash == std::string::npos) ? filepath : filepath.substr(slash + 1);
+
+	int const inotifyFd = inotify_init1(IN_CLOEXEC);
+	if (inotifyFd < 0 || inotify_add_watch(inotifyFd, directory.c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_TO) < 0) {
+		fprintf(stderr, "pridecat: Could not watch %s for changes.\n", filepath.c_str());
+		exit(1);
+	}
+
+	// appended chunks are too small to measure, so stick with the width the file starts out with
+	if (two_dimensiona_flag) {
+		g_fixedFlagWidth = longestLineLength(fh);
+	}
+
+	catFile(fh);
+	fflush(stdout);
+
+	alignas(inotify_event) char events[4096];
+	while (true) {
+		ssize_t const length = read(inotifyFd, events, sizeof(events));
+		if (length < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			fprintf(stderr, "pridecat: Lost track of %s.\n", filepath.c_str());
+			exit(1);
+		}
+
+		bool fileChanged = false;
+		for (ssize_t offset = 0; offset < length;) {
+			auto const* event = reinterpret_cast<inotify_event const*>(events + offset);
+			if (event->len > 0 && filename == event->name) {
+				fileChanged = true;
+			}
+			offset += sizeof(inotify_event) + event->len;
+		}
+		if (!fileChanged) {
+			continue;
+		}
+
+		struct stat pathInfo, openInfo;
+		if (stat(filepath.c_str(), &pathInfo) == 0 && fstat(fileno(fh), &openInfo) == 0) {
+			if (pathInfo.st_ino != openInfo.st_ino || pathInfo.st_dev != openInfo.st_dev) {
+				// rotated: finish off the old file before switching over
+				clearerr(fh);
+				catFile(fh);
+				if (FILE* const newFh = fopen(filepath.c_str(), "rb")) {
+					fclose(fh);
+					fh = newFh;
+				}
+			} else if (pathInfo.st_size < ftell(fh)) {
+				// truncated
+				fseek(fh, 0, SEEK_SET);
+			}
+		}
+
+		clearerr(fh);
+		catFile(fh);
+		fflush(stdout);
+	}
+}
+#endif
+
 #if defined(_WIN32)
 bool tryEnableEscapeSequences()
 {
@@ -736,16 +1264,49 @@ int main(int argc, char** argv) {
 		pushFlag(allFlags.at("lgbt"));
 	}
 
-	setColor(g_colorQueue[0]);
+	g_currentRow = g_startLine % flagHeight();
+
+	if (g_useByteRange && (g_filesToCat.size() != 1 || g_filesToCat[0].empty() || g_followLastFile || g_startLine != 0)) {
+		fprintf(stderr, "pridecat: --byte-range needs exactly one file, and can't be combined with --follow or --start-line\n");
+		return 1;
+	}
+
+	if (g_followLastFile) {
+#if defined(__linux__)
+		if (g_filesToCat.empty() || g_filesToCat.back().empty()) {
+			fprintf(stderr, "pridecat: --follow needs a file to follow, not stdin\n");
+			return 1;
+		}
+#else
+		fprintf(stderr, "pridecat: --follow is only supported on Linux\n");
+		return 1;
+#endif
+	}
+
+	// only the first shard of a byte range starts the document
+	if (g_outputFormat == outputFormat::html && g_byteRangeStart == 0) {
+		writeHtmlHeader();
+	}
+
+	// a shard that starts mid-file picks up the color the previous shard left active
+	if (g_byteRangeStart == 0) {
+		setColor(g_colorQueue[two_dimensiona_flag ? 0 : g_currentRow]);
+	}
 
+	bool reachedEndOfInput = true;
 	if (g_filesToCat.empty()) {
 		catFile(stdin);
 	} else {
-		for (auto const& filepath : g_filesToCat) {
+		for (size_t i = 0; i < g_filesToCat.size(); ++i) {
+			std::string const& filepath = g_filesToCat[i];
 			if (filepath.empty()) {
 				catFile(stdin);
 			} else {
-				FILE* fh = fopen(filepath.c_str(), "rb");
+				// a followed file is read as-is, since its inode is what tells us about rotation
+				bool const follow = g_followLastFile && i + 1 == g_filesToCat.size();
+				FILE* fh = follow
+					? fopen(filepath.c_str(), "rb")
+					: openInput(filepath, two_dimensiona_flag || g_useByteRange);
 				if (!fh) {
 					fprintf(
 						stderr,
@@ -754,13 +1315,37 @@ int main(int argc, char** argv) {
 					);
 					return 1;
 				}
-				catFile(fh);
+#if defined(__linux__)
+				if (follow) {
+					followFile(fh, filepath);
+				}
+#endif
+				if (g_useByteRange) {
+					reachedEndOfInput = catByteRange(fh);
+				} else {
+					catFile(fh);
+				}
 				fclose(fh);
 			}
 		}
 	}
 
-	resetColor();
+	// leave the color active for the next shard, so concatenated shards match a single run
+	if (reachedEndOfInput) {
+		resetColor();
+	}
+
+	// a shard that stops early leaves its span open, and the next shard carries on inside it
+	if (g_outputFormat == outputFormat::html && reachedEndOfInput) {
+		writeHtmlFooter();
+	}
+
+#if !defined(_WIN32)
+	// the output is cut short, so don't let scripts mistake it for success
+	if (g_decompressFailed) {
+		return 1;
+	}
+#endif
 
 	return 0;
 }